@@ -598,6 +598,16 @@ std::string indent_nested_curly_braces(std::string input_string, int modeCurlyBr
 }
 // end of HT-Lib.htvm
 std::vector<std::string> allFuncNames_GLOABAL;
+std::vector<std::string> allCallFrom_GLOABAL;
+std::vector<std::string> allCallTo_GLOABAL;
+std::vector<std::string> reachableFuncs_GLOABAL;
+std::string currentFuncName_GLOABAL = "";
+int treeShake_GLOABAL = 0;
+std::vector<std::string> pureFuncs_GLOABAL;
+std::vector<std::string> memoMarked_GLOABAL;
+int memoAll_GLOABAL = 0;
+int optimize_GLOABAL = 0;
+int loopTempCount_GLOABAL = 0;
 bool isInAllFuncNames_GLOABAL(std::string line) {
     for (int A_Index20 = 0; A_Index20 < HTVM_Size(allFuncNames_GLOABAL); A_Index20++) {
         if (line == allFuncNames_GLOABAL[A_Index20]) {
@@ -626,6 +636,9 @@ std::string expressionParser(std::string line) {
         std::string A_LoopField21 = items21[A_Index21 - 0];
         if (isInAllFuncNames_GLOABAL(StrSplit(A_LoopField21, " ", 1))) {
             outTemp4 = "";
+            // record the call graph edge for tree shaking
+            HTVM_Append(allCallFrom_GLOABAL, currentFuncName_GLOABAL);
+            HTVM_Append(allCallTo_GLOABAL, StrSplit(A_LoopField21, " ", 1));
             std::vector<std::string> items22 = LoopParseFunc(A_LoopField21, " ");
             for (size_t A_Index22 = 0; A_Index22 < items22.size(); A_Index22++) {
                 std::string A_LoopField22 = items22[A_Index22 - 0];
@@ -643,14 +656,623 @@ std::string expressionParser(std::string line) {
     line = outTemp3;
     return line;
 }
+bool isReachableFunc_GLOABAL(std::string name) {
+    for (int A_Index23 = 0; A_Index23 < HTVM_Size(reachableFuncs_GLOABAL); A_Index23++) {
+        if (name == reachableFuncs_GLOABAL[A_Index23]) {
+            return true;
+        }
+    }
+    return false;
+}
+// top-level code has the caller name "" so it is the root of the call graph
+void markReachableFuncs() {
+    int changed = 1;
+    HTVM_Append(reachableFuncs_GLOABAL, "");
+    while (changed == 1) {
+        changed = 0;
+        for (int A_Index24 = 0; A_Index24 < HTVM_Size(allCallTo_GLOABAL); A_Index24++) {
+            if (isReachableFunc_GLOABAL(allCallFrom_GLOABAL[A_Index24]) && !isReachableFunc_GLOABAL(allCallTo_GLOABAL[A_Index24])) {
+                HTVM_Append(reachableFuncs_GLOABAL, allCallTo_GLOABAL[A_Index24]);
+                changed = 1;
+            }
+        }
+    }
+}
+std::string treeShake(std::string code) {
+    std::string out = "";
+    std::string removed = "";
+    std::string funcName = "";
+    int depth = 0;
+    int skipping = 0;
+    int removedFuncs = 0;
+    markReachableFuncs();
+    std::vector<std::string> items25 = LoopParseFunc(code, "\n", "\r");
+    for (size_t A_Index25 = 0; A_Index25 < items25.size(); A_Index25++) {
+        std::string A_LoopField25 = items25[A_Index25 - 0];
+        if (depth == 0 && SubStr(A_LoopField25, 1, 5) == "func ") {
+            funcName = Trim(StrSplit(StringTrimLeft(A_LoopField25, 5), "(", 1));
+            if (!isReachableFunc_GLOABAL(funcName)) {
+                skipping = 1;
+                removedFuncs++;
+            }
+        }
+        if (SubStr(A_LoopField25, -1) == "{") {
+            depth++;
+        }
+        if (A_LoopField25 == "}") {
+            depth--;
+        }
+        if (skipping == 1) {
+            removed += A_LoopField25 + Chr(10);
+            if (depth == 0) {
+                skipping = 0;
+            }
+        } else {
+            out += A_LoopField25 + Chr(10);
+        }
+    }
+    out = StringTrimRight(out, 1);
+    print("Tree shaking: removed " + STR(removedFuncs) + " unused functions (" + STR(StrLen(restoreStrings(removed))) + " bytes)");
+    return out;
+}
+bool isPureFunc_GLOABAL(std::string name) {
+    for (int A_Index26 = 0; A_Index26 < HTVM_Size(pureFuncs_GLOABAL); A_Index26++) {
+        if (name == pureFuncs_GLOABAL[A_Index26]) {
+            return true;
+        }
+    }
+    return false;
+}
+bool isMemoMarked_GLOABAL(std::string name) {
+    for (int A_Index27 = 0; A_Index27 < HTVM_Size(memoMarked_GLOABAL); A_Index27++) {
+        if (name == memoMarked_GLOABAL[A_Index27]) {
+            return true;
+        }
+    }
+    return false;
+}
+bool isPureToken(std::string tok, std::string funcName, std::string paramNames) {
+    if (InStr("0123456789", SubStr(tok, 1, 1))) {
+        return true;
+    }
+    if (InStr(paramNames, " " + tok + " ")) {
+        return true;
+    }
+    if (tok == funcName || isPureFunc_GLOABAL(tok)) {
+        return true;
+    }
+    if (tok == "and" || tok == "or" || tok == "not" || tok == "true" || tok == "false") {
+        return true;
+    }
+    // a preserved string literal
+    if (InStr(tok, "VYIGUOYIYVIUCFCYIUCFCYIGCYGICFHYFHCTCFTFDFGYGFC") == 1) {
+        return true;
+    }
+    return false;
+}
+// pure means every identifier is a literal, a parameter, the function itself or an already pure function
+bool isPureExpr(std::string expr, std::string funcName, std::string paramNames) {
+    std::string tok = "";
+    expr += " ";
+    std::vector<std::string> items28 = LoopParseFunc(expr);
+    for (size_t A_Index28 = 0; A_Index28 < items28.size(); A_Index28++) {
+        std::string A_LoopField28 = items28[A_Index28 - 0];
+        if (InStr("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_", A_LoopField28)) {
+            tok += A_LoopField28;
+        } else {
+            if (tok != "" && !isPureToken(tok, funcName, paramNames)) {
+                return false;
+            }
+            tok = "";
+        }
+    }
+    return true;
+}
+std::string funcParamNames(std::string line) {
+    std::string paramNames = " ";
+    std::string paramList = StrSplit(StrSplit(line, "(", 2), ")", 1);
+    std::vector<std::string> items29 = LoopParseFunc(paramList, ",");
+    for (size_t A_Index29 = 0; A_Index29 < items29.size(); A_Index29++) {
+        std::string A_LoopField29 = items29[A_Index29 - 0];
+        if (Trim(A_LoopField29) != "") {
+            paramNames += Trim(StrSplit(Trim(A_LoopField29), " ", 1)) + " ";
+        }
+    }
+    return paramNames;
+}
+// purity analysis over one-liner functions: func line, a single return line, then the closing brace
+void findPureFuncs(std::string code) {
+    std::vector<std::string> lines;
+    std::string funcName = "";
+    std::vector<std::string> items30 = LoopParseFunc(code, "\n", "\r");
+    for (size_t A_Index30 = 0; A_Index30 < items30.size(); A_Index30++) {
+        std::string A_LoopField30 = items30[A_Index30 - 0];
+        HTVM_Append(lines, A_LoopField30);
+    }
+    HTVM_Append(lines, "");
+    HTVM_Append(lines, "");
+    for (int A_Index31 = 0; A_Index31 < HTVM_Size(lines) - 2; A_Index31++) {
+        if (SubStr(lines[A_Index31], 1, 5) == "func " && SubStr(lines[A_Index31 + 1], 1, 7) == "return " && lines[A_Index31 + 2] == "}") {
+            funcName = Trim(StrSplit(StringTrimLeft(lines[A_Index31], 5), "(", 1));
+            if (isPureExpr(StringTrimLeft(lines[A_Index31 + 1], 7), funcName, funcParamNames(lines[A_Index31]))) {
+                HTVM_Append(pureFuncs_GLOABAL, funcName);
+            }
+        }
+    }
+}
+bool hasToken(std::string text, std::string name) {
+    std::string tok = "";
+    text += " ";
+    std::vector<std::string> items32 = LoopParseFunc(text);
+    for (size_t A_Index32 = 0; A_Index32 < items32.size(); A_Index32++) {
+        std::string A_LoopField32 = items32[A_Index32 - 0];
+        if (InStr("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_", A_LoopField32)) {
+            tok += A_LoopField32;
+        } else {
+            if (tok == name) {
+                return true;
+            }
+            tok = "";
+        }
+    }
+    return false;
+}
+bool isIdentChar(std::string c) {
+    if (c == "") {
+        return false;
+    }
+    if (InStr("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_", c)) {
+        return true;
+    }
+    return false;
+}
+std::string leadingDigits(std::string text) {
+    std::string digits = "";
+    std::vector<std::string> items33 = LoopParseFunc(text);
+    for (size_t A_Index33 = 0; A_Index33 < items33.size(); A_Index33++) {
+        std::string A_LoopField33 = items33[A_Index33 - 0];
+        if (!InStr("0123456789", A_LoopField33)) {
+            break;
+        }
+        digits += A_LoopField33;
+    }
+    return digits;
+}
+std::string trailingDigits(std::string text) {
+    std::string digits = "";
+    while (text != "" && InStr("0123456789", SubStr(text, -1))) {
+        digits = SubStr(text, -1) + digits;
+        text = StringTrimRight(text, 1);
+    }
+    return digits;
+}
+// the trip count of "Loop, expr {" when expr is made only of integer literals, + - and * and stays within the unroll limit of 4, otherwise -1
+// bailing out past the limit keeps every product and sum far from overflowing
+int foldConstant(std::string expr) {
+    int total = 0;
+    int term = 1;
+    int sign = 1;
+    int num = 0;
+    std::string digits = "";
+    expr = StrReplace(expr, " ", "");
+    if (expr == "") {
+        return -1;
+    }
+    expr += "+";
+    std::vector<std::string> items34 = LoopParseFunc(expr);
+    for (size_t A_Index34 = 0; A_Index34 < items34.size(); A_Index34++) {
+        std::string A_LoopField34 = items34[A_Index34 - 0];
+        if (InStr("0123456789", A_LoopField34)) {
+            digits += A_LoopField34;
+            num = num * 10 + InStr("0123456789", A_LoopField34) - 1;
+            if (StrLen(digits) > 6) {
+                return -1;
+            }
+        }
+        else if (InStr("+-*", A_LoopField34) && digits != "") {
+            term = term * num;
+            if (term > 4) {
+                return -1;
+            }
+            num = 0;
+            digits = "";
+            if (A_LoopField34 != "*") {
+                total = total + sign * term;
+                if (total > 4) {
+                    return -1;
+                }
+                term = 1;
+                sign = 1;
+                if (A_LoopField34 == "-") {
+                    sign = -1;
+                }
+            }
+        } else {
+            return -1;
+        }
+    }
+    if (total < 0) {
+        return 0;
+    }
+    return total;
+}
+// replaces find in text only where it is not part of a longer identifier
+std::string replaceWhole(std::string text, std::string find, std::string with) {
+    std::string out = "";
+    int pos = InStr(text, find);
+    while (pos > 0) {
+        out += SubStr(text, 1, pos - 1);
+        text = StringTrimLeft(text, pos - 1);
+        if (isIdentChar(SubStr(out, -1)) || (isIdentChar(SubStr(find, -1)) && isIdentChar(SubStr(text, StrLen(find) + 1, 1)))) {
+            out += find;
+        } else {
+            out += with;
+        }
+        text = StringTrimLeft(text, StrLen(find));
+        pos = InStr(text, find);
+    }
+    out += text;
+    return out;
+}
+std::string matchParen(std::string text, int start) {
+    std::string call = "";
+    int depth = 0;
+    std::vector<std::string> items35 = LoopParseFunc(text);
+    for (size_t A_Index35 = 0; A_Index35 < items35.size(); A_Index35++) {
+        std::string A_LoopField35 = items35[A_Index35 - 0];
+        if (A_Index35 >= start) {
+            call += A_LoopField35;
+            if (A_LoopField35 == "(") {
+                depth++;
+            }
+            if (A_LoopField35 == ")") {
+                depth--;
+                if (depth == 0) {
+                    return call;
+                }
+            }
+        }
+    }
+    return "";
+}
+// true when every token of call is a literal, a keyword, a variable the loop does not assign or a pure function
+bool isInvariantCall(std::string call, std::string assigned) {
+    std::string tok = "";
+    // so that a call written as "name (" is still seen as a call
+    while (InStr(call, " (")) {
+        call = StrReplace(call, " (", "(");
+    }
+    std::vector<std::string> items36 = LoopParseFunc(call);
+    for (size_t A_Index36 = 0; A_Index36 < items36.size(); A_Index36++) {
+        std::string A_LoopField36 = items36[A_Index36 - 0];
+        if (isIdentChar(A_LoopField36)) {
+            tok += A_LoopField36;
+        } else {
+            if (tok == "and" || tok == "or" || tok == "not" || tok == "true" || tok == "false") {
+                tok = "";
+            }
+            if (tok != "") {
+                if (A_LoopField36 == "(") {
+                    if (!isPureFunc_GLOABAL(tok)) {
+                        return false;
+                    }
+                }
+                else if (!InStr("0123456789", SubStr(tok, 1, 1)) && InStr(tok, "VYIGUOYIYVIUCFCYIUCFCYIGCYGICFHYFHCTCFTFDFGYGFC") != 1) {
+                    if (tok == "A_Index" || InStr(" " + assigned + " ", " " + tok + " ")) {
+                        return false;
+                    }
+                }
+            }
+            tok = "";
+        }
+    }
+    return true;
+}
+// the first pure call in body that is invariant in the loop
+std::string findInvariantCall(std::string body, std::string assigned) {
+    std::string tok = "";
+    std::string call = "";
+    std::vector<std::string> items37 = LoopParseFunc(body);
+    for (size_t A_Index37 = 0; A_Index37 < items37.size(); A_Index37++) {
+        std::string A_LoopField37 = items37[A_Index37 - 0];
+        if (A_LoopField37 == "(" && tok != "" && isPureFunc_GLOABAL(tok)) {
+            call = tok + matchParen(body, A_Index37);
+            if (call != tok && isInvariantCall(call, assigned)) {
+                return call;
+            }
+        }
+        if (isIdentChar(A_LoopField37)) {
+            tok += A_LoopField37;
+        } else {
+            tok = "";
+        }
+    }
+    return "";
+}
+bool isSafeBeforeProduct(std::string text) {
+    std::string c = SubStr(Trim(text), -1);
+    if (isIdentChar(c) || (InStr("*/%^.", c) && c != "")) {
+        return false;
+    }
+    return true;
+}
+bool isSafeAfterProduct(std::string c) {
+    if (isIdentChar(c) || (InStr("*^.", c) && c != "")) {
+        return false;
+    }
+    return true;
+}
+// the position of the first A_Index*K or K*A_Index that an induction variable can replace, otherwise 0
+int findScaledIndex(std::string text) {
+    std::string before = "";
+    std::string rest = text;
+    std::string k = "";
+    int pos = InStr(rest, "A_Index");
+    while (pos > 0) {
+        before += SubStr(rest, 1, pos - 1);
+        rest = StringTrimLeft(rest, pos - 1 + 7);
+        if (SubStr(rest, 1, 1) == "*") {
+            k = leadingDigits(StringTrimLeft(rest, 1));
+            if (k != "" && isSafeBeforeProduct(before) && isSafeAfterProduct(SubStr(rest, StrLen(k) + 2, 1))) {
+                return StrLen(before) + 1;
+            }
+        }
+        if (SubStr(before, -1) == "*" && isSafeAfterProduct(SubStr(rest, 1, 1))) {
+            k = trailingDigits(StringTrimRight(before, 1));
+            if (k != "" && isSafeBeforeProduct(StringTrimRight(before, StrLen(k) + 1))) {
+                return StrLen(before) - StrLen(k);
+            }
+        }
+        before += "A_Index";
+        pos = InStr(rest, "A_Index");
+    }
+    return 0;
+}
+// loop pass for -O over innermost loops: unroll small constant-trip loops, hoist invariant pure calls and strength-reduce A_Index*K
+std::string optimizeLoops(std::string code) {
+    std::vector<std::string> lines;
+    std::string out = "";
+    std::string body = "";
+    std::string pre = "";
+    std::string post = "";
+    std::string assigned = "";
+    std::string call = "";
+    std::string temp = "";
+    std::string k = "";
+    std::string ivMap = "";
+    int i = 0;
+    int callsImpure = 0;
+    int j = 0;
+    int pos = 0;
+    int depth = 0;
+    int trips = 0;
+    int hoisted = 0;
+    int unrolled = 0;
+    int reduced = 0;
+    std::vector<std::string> items38 = LoopParseFunc(code, "\n", "\r");
+    for (size_t A_Index38 = 0; A_Index38 < items38.size(); A_Index38++) {
+        std::string A_LoopField38 = items38[A_Index38 - 0];
+        HTVM_Append(lines, A_LoopField38);
+    }
+    while (i < HTVM_Size(lines)) {
+        // find the end of an innermost loop starting at lines[i], j stays -1 otherwise
+        j = -1;
+        if (SubStr(lines[i], 1, 6) == "Loop, " && SubStr(lines[i], -1) == "{") {
+            depth = 0;
+            for (int A_Index39 = 0; A_Index39 < HTVM_Size(lines) - i; A_Index39++) {
+                if (A_Index39 > 0 && SubStr(lines[i + A_Index39], 1, 6) == "Loop, ") {
+                    break;
+                }
+                if (SubStr(lines[i + A_Index39], -1) == "{") {
+                    depth++;
+                }
+                if (lines[i + A_Index39] == "}") {
+                    depth--;
+                }
+                if (depth == 0) {
+                    j = i + A_Index39;
+                    break;
+                }
+            }
+        }
+        if (j == -1) {
+            out += lines[i] + Chr(10);
+            i++;
+        } else {
+            body = "";
+            assigned = "";
+            for (int A_Index40 = 0; A_Index40 < j - i - 1; A_Index40++) {
+                body += lines[i + A_Index40 + 1] + Chr(10);
+                if (InStr(lines[i + A_Index40 + 1], " := ")) {
+                    assigned += StrSplit(lines[i + A_Index40 + 1], " := ", 1) + " ";
+                }
+            }
+            trips = foldConstant(StringTrimRight(StringTrimLeft(lines[i], 6), 2));
+            if (trips >= 0 && trips <= 4 && j - i - 1 <= 8) {
+                for (int A_Index41 = 0; A_Index41 < trips; A_Index41++) {
+                    out += replaceWhole(body, "A_Index", STR(A_Index41));
+                }
+                unrolled++;
+            } else {
+                pre = "";
+                post = "";
+                ivMap = "";
+                call = "";
+                // an impure call in the body may change the arguments of a pure one
+                callsImpure = 0;
+                for (int A_Index42 = 0; A_Index42 < HTVM_Size(allFuncNames_GLOABAL); A_Index42++) {
+                    if (hasToken(body, allFuncNames_GLOABAL[A_Index42]) && !isPureFunc_GLOABAL(allFuncNames_GLOABAL[A_Index42])) {
+                        callsImpure = 1;
+                    }
+                }
+                if (callsImpure == 0) {
+                    call = findInvariantCall(body, Trim(assigned));
+                }
+                while (call != "") {
+                    loopTempCount_GLOABAL++;
+                    temp = "hssInv" + STR(loopTempCount_GLOABAL);
+                    pre += temp + " := " + call + Chr(10);
+                    body = replaceWhole(body, call, temp);
+                    hoisted++;
+                    call = findInvariantCall(body, Trim(assigned));
+                }
+                // a reentrant call in the body would reset the shared induction variable
+                pos = 0;
+                if (callsImpure == 0) {
+                    pos = findScaledIndex(body);
+                }
+                while (pos > 0) {
+                    if (SubStr(body, pos, 8) == "A_Index*") {
+                        k = leadingDigits(SubStr(body, pos + 8));
+                    } else {
+                        k = leadingDigits(SubStr(body, pos));
+                    }
+                    if (InStr(ivMap, "|" + k + "=")) {
+                        temp = StrSplit(StrSplit(ivMap, "|" + k + "=", 2), "|", 1);
+                    } else {
+                        loopTempCount_GLOABAL++;
+                        temp = "hssIv" + STR(loopTempCount_GLOABAL);
+                        ivMap += "|" + k + "=" + temp + "|";
+                        pre += temp + " := 0" + Chr(10);
+                        post += temp + " := " + temp + " + " + k + Chr(10);
+                    }
+                    body = SubStr(body, 1, pos - 1) + temp + StringTrimLeft(body, pos - 1 + StrLen(k) + 8);
+                    reduced++;
+                    pos = findScaledIndex(body);
+                }
+                out += pre;
+                out += lines[i] + Chr(10) + body + post + lines[j] + Chr(10);
+            }
+            i = j + 1;
+        }
+    }
+    out = StringTrimRight(out, 1);
+    print("Loop optimization: hoisted " + STR(hoisted) + " calls, unrolled " + STR(unrolled) + " loops, reduced " + STR(reduced) + " multiplications");
+    return out;
+}
+bool callsUserFunc(std::string expr) {
+    for (int A_Index43 = 0; A_Index43 < HTVM_Size(allFuncNames_GLOABAL); A_Index43++) {
+        if (hasToken(expr, allFuncNames_GLOABAL[A_Index43])) {
+            return true;
+        }
+    }
+    return false;
+}
+std::string memoize(std::string code) {
+    std::vector<std::string> lines;
+    std::string out = "";
+    std::string funcName = "";
+    std::string memoKey = "";
+    std::string paramNames = "";
+    std::string hashFunc = "";
+    int i = 0;
+    int memoCount = 0;
+    std::vector<std::string> items44 = LoopParseFunc(code, "\n", "\r");
+    for (size_t A_Index44 = 0; A_Index44 < items44.size(); A_Index44++) {
+        std::string A_LoopField44 = items44[A_Index44 - 0];
+        HTVM_Append(lines, A_LoopField44);
+    }
+    HTVM_Append(lines, "");
+    HTVM_Append(lines, "");
+    while (i < HTVM_Size(lines) - 2) {
+        funcName = "";
+        if (SubStr(lines[i], 1, 5) == "func " && SubStr(lines[i + 1], 1, 7) == "return " && lines[i + 2] == "}") {
+            funcName = Trim(StrSplit(StringTrimLeft(lines[i], 5), "(", 1));
+            if (memoAll_GLOABAL != 1 && !isMemoMarked_GLOABAL(funcName)) {
+                funcName = "";
+            }
+            else if (!isPureFunc_GLOABAL(funcName)) {
+                if (isMemoMarked_GLOABAL(funcName)) {
+                    print("Warning: " + funcName + " is not a pure one-liner and will not be memoized");
+                }
+                funcName = "";
+            }
+            // a constant or a call-free expression is cheaper than the cache lookup
+            else if (Trim(funcParamNames(lines[i])) == "" || !callsUserFunc(StringTrimLeft(lines[i + 1], 7))) {
+                if (isMemoMarked_GLOABAL(funcName)) {
+                    print("Warning: " + funcName + " has no parameters or no calls and will not be memoized");
+                }
+                funcName = "";
+            }
+        }
+        if (funcName == "") {
+            out += lines[i] + Chr(10);
+            i++;
+        } else {
+            // the key is the argument tuple with every argument prefixed by its length, so no two tuples collide
+            memoKey = Chr(34) + "|" + Chr(34);
+            paramNames = Trim(funcParamNames(lines[i]));
+            std::vector<std::string> items45 = LoopParseFunc(paramNames, " ");
+            for (size_t A_Index45 = 0; A_Index45 < items45.size(); A_Index45++) {
+                std::string A_LoopField45 = items45[A_Index45 - 0];
+                memoKey += " . STR(StrLen(STR(" + A_LoopField45 + "))) . " + Chr(34) + ":" + Chr(34) + " . STR(" + A_LoopField45 + ")";
+            }
+            // a bounded direct-mapped cache of 251 slots
+            out += "arr hssMemoKeys_" + funcName + Chr(10);
+            out += "arr hssMemoVals_" + funcName + Chr(10);
+            out += "Loop, 251 {" + Chr(10);
+            out += "hssMemoKeys_" + funcName + ".add(" + Chr(34) + Chr(34) + ")" + Chr(10);
+            out += "hssMemoVals_" + funcName + ".add(" + Chr(34) + Chr(34) + ")" + Chr(10);
+            out += "}" + Chr(10);
+            out += lines[i] + Chr(10);
+            // typed locals, so recursive calls cannot overwrite the key and slot
+            out += "str hssMemoKey := " + memoKey + Chr(10);
+            out += "int hssMemoSlot := hssMemoSlot_HSS(hssMemoKey)" + Chr(10);
+            out += "if (hssMemoKeys_" + funcName + "[hssMemoSlot] = hssMemoKey) {" + Chr(10);
+            out += "return hssMemoVals_" + funcName + "[hssMemoSlot]" + Chr(10);
+            out += "}" + Chr(10);
+            out += "hssMemoVal := " + StringTrimLeft(lines[i + 1], 7) + Chr(10);
+            out += "hssMemoKeys_" + funcName + "[hssMemoSlot] := hssMemoKey" + Chr(10);
+            out += "hssMemoVals_" + funcName + "[hssMemoSlot] := hssMemoVal" + Chr(10);
+            out += "return hssMemoVal" + Chr(10);
+            out += "}" + Chr(10);
+            memoCount++;
+            i += 3;
+        }
+    }
+    out = StringTrimRight(out, 1);
+    if (memoCount > 0) {
+        hashFunc += "func hssMemoSlot_HSS(key) {" + Chr(10);
+        hashFunc += "int hssMemoHash := 5381" + Chr(10);
+        hashFunc += "Loop, Parse, key {" + Chr(10);
+        hashFunc += "hssMemoHash := Mod(hssMemoHash * 33 + Asc(A_LoopField), 1000003)" + Chr(10);
+        hashFunc += "}" + Chr(10);
+        hashFunc += "return Mod(hssMemoHash, 251)" + Chr(10);
+        hashFunc += "}" + Chr(10);
+        out = hashFunc + out;
+    }
+    print("Memoization: wrapped " + STR(memoCount) + " pure functions");
+    return out;
+}
 int main(int argc, char* argv[]) {
     std::string code = "";
     std::string out = "";
     std::string outTemp1 = "";
     std::string outTemp2 = "";
-    std::string params = getLangParams("h_sharp", "hss");
+    std::string fileName = "";
+    int blockDepth = 0;
+    int funcDepth = 0;
+    std::string params = getLangParams("h_sharp", "hss", "[-shake] [-memo] [-O]");
     if (params != "") {
-        code = FileRead(params);
+        std::vector<std::string> items46 = LoopParseFunc(params, "\n", "\r");
+        for (size_t A_Index46 = 0; A_Index46 < items46.size(); A_Index46++) {
+            std::string A_LoopField46 = items46[A_Index46 - 0];
+            if (A_Index46 == 0) {
+                fileName = Trim(A_LoopField46);
+            }
+            else if (Trim(A_LoopField46) == "-shake") {
+                treeShake_GLOABAL = 1;
+            }
+            else if (Trim(A_LoopField46) == "-memo") {
+                memoAll_GLOABAL = 1;
+            }
+            else if (Trim(A_LoopField46) == "-O") {
+                optimize_GLOABAL = 1;
+            } else {
+                print("Unknown flag: " + Trim(A_LoopField46));
+            }
+        }
+        code = FileRead(fileName);
         code = cleanUpFirst(code);
         code = preserveStrings(code);
         code = handleComments(code, ";");
@@ -665,52 +1287,70 @@ int main(int argc, char* argv[]) {
         code = StrReplace(code, "?", Chr(10) + "---?");
         code = StrReplace(code, ".", Chr(10) + "." + Chr(10));
         code = indent_nested_curly_braces(code);
-        std::vector<std::string> items23 = LoopParseFunc(code, "\n", "\r");
-        for (size_t A_Index23 = 0; A_Index23 < items23.size(); A_Index23++) {
-            std::string A_LoopField23 = items23[A_Index23 - 0];
-            out += Trim(A_LoopField23) + Chr(10);
+        std::vector<std::string> items47 = LoopParseFunc(code, "\n", "\r");
+        for (size_t A_Index47 = 0; A_Index47 < items47.size(); A_Index47++) {
+            std::string A_LoopField47 = items47[A_Index47 - 0];
+            out += Trim(A_LoopField47) + Chr(10);
         }
         code = StringTrimRight(out, 1);
         out = "";
-        std::vector<std::string> items24 = LoopParseFunc(code, "\n", "\r");
-        for (size_t A_Index24 = 0; A_Index24 < items24.size(); A_Index24++) {
-            std::string A_LoopField24 = items24[A_Index24 - 0];
-            if (InStr(A_LoopField24, "{")) {
-                out += Trim("Loop, " + expressionParser(Trim(StrReplace(A_LoopField24, "{", ""))) + " {") + Chr(10);
+        std::vector<std::string> items48 = LoopParseFunc(code, "\n", "\r");
+        for (size_t A_Index48 = 0; A_Index48 < items48.size(); A_Index48++) {
+            std::string A_LoopField48 = items48[A_Index48 - 0];
+            if (InStr(A_LoopField48, "{")) {
+                blockDepth++;
+                out += Trim("Loop, " + expressionParser(Trim(StrReplace(A_LoopField48, "{", ""))) + " {") + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 1) == "<") {
-                out += Trim("return " + expressionParser(StringTrimLeft(A_LoopField24, 1))) + Chr(10);
+            else if (SubStr(Trim(A_LoopField48), 1, 1) == "<") {
+                out += Trim("return " + expressionParser(StringTrimLeft(A_LoopField48, 1))) + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 1) == "^") {
-                out += Trim("print(" + expressionParser(StringTrimLeft(A_LoopField24, 1))) + ")" + Chr(10);
+            else if (SubStr(Trim(A_LoopField48), 1, 1) == "^") {
+                out += Trim("print(" + expressionParser(StringTrimLeft(A_LoopField48, 1))) + ")" + Chr(10);
             }
-            else if (Trim(A_LoopField24) == ".") {
+            else if (Trim(A_LoopField48) == "." || Trim(A_LoopField48) == "}") {
+                blockDepth--;
+                if (blockDepth == funcDepth) {
+                    currentFuncName_GLOABAL = "";
+                }
                 out += "}" + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 4) == "-???") {
-                outTemp1 = StringTrimLeft(A_LoopField24, 4);
+            else if (SubStr(Trim(A_LoopField48), 1, 4) == "-???") {
+                outTemp1 = StringTrimLeft(A_LoopField48, 4);
+                blockDepth++;
                 out += "else if (" + expressionParser(outTemp1) + ")" + " {" + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 4) == "---?") {
-                outTemp1 = StringTrimLeft(A_LoopField24, 4);
+            else if (SubStr(Trim(A_LoopField48), 1, 4) == "---?") {
+                outTemp1 = StringTrimLeft(A_LoopField48, 4);
+                blockDepth++;
                 out += "if (" + expressionParser(outTemp1) + ")" + " {" + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 4) == "--??") {
-                outTemp1 = StringTrimLeft(A_LoopField24, 4);
+            else if (SubStr(Trim(A_LoopField48), 1, 4) == "--??") {
+                outTemp1 = StringTrimLeft(A_LoopField48, 4);
+                blockDepth++;
                 out += "else {" + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 1) == "#") {
-                outTemp1 = Trim(StringTrimLeft(A_LoopField24, 1));
+            else if (SubStr(Trim(A_LoopField48), 1, 1) == "#") {
+                outTemp1 = Trim(StringTrimLeft(A_LoopField48, 1));
+                // #@name opts a single function into memoization
+                if (SubStr(outTemp1, 1, 1) == "@") {
+                    outTemp1 = StringTrimLeft(outTemp1, 1);
+                    HTVM_Append(memoMarked_GLOABAL, Trim(StrSplit(outTemp1, " ", 1)));
+                }
+                if (currentFuncName_GLOABAL == "") {
+                    currentFuncName_GLOABAL = Trim(StrSplit(outTemp1, " ", 1));
+                    funcDepth = blockDepth;
+                }
+                blockDepth++;
                 if (InStr(outTemp1, " ")) {
                     outTemp2 = "";
-                    std::vector<std::string> items25 = LoopParseFunc(outTemp1, " ");
-                    for (size_t A_Index25 = 0; A_Index25 < items25.size(); A_Index25++) {
-                        std::string A_LoopField25 = items25[A_Index25 - 0];
-                        if (A_Index25 == 0) {
-                            outTemp2 += A_LoopField25 + "(";
-                            HTVM_Append(allFuncNames_GLOABAL, Trim(A_LoopField25));
+                    std::vector<std::string> items49 = LoopParseFunc(outTemp1, " ");
+                    for (size_t A_Index49 = 0; A_Index49 < items49.size(); A_Index49++) {
+                        std::string A_LoopField49 = items49[A_Index49 - 0];
+                        if (A_Index49 == 0) {
+                            outTemp2 += A_LoopField49 + "(";
+                            HTVM_Append(allFuncNames_GLOABAL, Trim(A_LoopField49));
                         } else {
-                            outTemp2 += StrReplace(A_LoopField25, ":", " := ") + ", ";
+                            outTemp2 += StrReplace(A_LoopField49, ":", " := ") + ", ";
                         }
                     }
                     outTemp2 = StringTrimRight(outTemp2, 2);
@@ -720,23 +1360,33 @@ int main(int argc, char* argv[]) {
                     out += "func " + Trim(outTemp1) + "() {" + Chr(10);
                 }
             }
-            else if (InStr(A_LoopField24, ":") && SubStr(Trim(A_LoopField24), 1, 1) != "#") {
-                outTemp1 = StrSplit(A_LoopField24, ":", 1);
-                outTemp2 = StrSplit(A_LoopField24, ":", 2);
+            else if (InStr(A_LoopField48, ":") && SubStr(Trim(A_LoopField48), 1, 1) != "#") {
+                outTemp1 = StrSplit(A_LoopField48, ":", 1);
+                outTemp2 = StrSplit(A_LoopField48, ":", 2);
                 out += outTemp1 + " := " + Trim(expressionParser(outTemp2)) + Chr(10);
             }
-            else if (SubStr(Trim(A_LoopField24), 1, 1) == "/") {
-                out += Trim(expressionParser(A_LoopField24)) + Chr(10);
+            else if (SubStr(Trim(A_LoopField48), 1, 1) == "/") {
+                out += Trim(expressionParser(A_LoopField48)) + Chr(10);
             } else {
-                out += Trim(A_LoopField24) + Chr(10);
+                out += Trim(A_LoopField48) + Chr(10);
             }
         }
         code = StringTrimRight(out, 1);
+        if (treeShake_GLOABAL == 1) {
+            code = treeShake(code);
+        }
+        findPureFuncs(code);
+        if (optimize_GLOABAL == 1) {
+            code = optimizeLoops(code);
+        }
+        if (memoAll_GLOABAL == 1 || HTVM_Size(memoMarked_GLOABAL) > 0) {
+            code = memoize(code);
+        }
         print(code);
         // end code
         code = indent_nested_curly_braces(code);
         code = restoreStrings(code);
-        saveOutput(code, StringTrimRight(params, 3) + "htvm");
+        saveOutput(code, StringTrimRight(fileName, 3) + "htvm");
     }
     
 